@@ -20,7 +20,9 @@ using namespace glm;
 // Include Shader and Object Loader
 #include "src/shader.h"
 #include "src/objloader.h"
+#include "src/meshpack.h"
 using namespace lOBJ;
+using namespace lMPK;
 
 
 
@@ -38,7 +40,7 @@ unsigned int SCR_HEIGHT = 600;
 // shader paths
 const char* pathVShader = "data/shaderVert.hlsl"; // ? relative to final application location?
 const char* pathFShader = "data/shaderFrag.hlsl"; // ? relative to final application location?
-// obj file path
+// obj file path -- packed next to itself as .mpk on first run (or when changed), then streamed progressively
 const char* pathOBJ = "data/objs/cube_tris.obj"; // ? relative to final application location?
 
 
@@ -57,6 +59,10 @@ const char* pathOBJ = "data/objs/cube_tris.obj"; // ? relative to final applicat
 ///		david aloka <d@preform.io>, copyright 2022
 /// </author>
 /// <history>
+///		2026.10.19
+///			- added compressed, chunked mesh container (src/meshpack.h) that is
+///			decoded on worker threads and uploaded chunk by chunk as it arrives,
+///			so large models appear progressively instead of after a full OBJ parse
 ///		2022.02.19 12:50
 ///			- implemented perspective projection camera including 
 ///			model, view, and projection transformations
@@ -128,14 +134,20 @@ int main(void)
 
 	// set up vertex data (and buffer(s)) and configure vertex attributes
 	// ------------------------------------------------------------------
-	// load vertex data from OBJ file
+	// stream vertex data from the packed mesh; if it is missing, stale or damaged,
+	// parse the OBJ file once, pack it for next run and draw the parsed vertices now
 	// --
+	double loadStart = glfwGetTime();
+	string pathMPK = packPath(pathOBJ);
+	MeshStream meshStream;
+	bool meshStreaming = meshStream.open(pathMPK.c_str(), pathOBJ);
+	bool firstTriangle = true;
 	// set up variables to receive mesh data
 	vector< float > vertices;
-	vector< vec2 > uvs; // Won't be used at the moment either?
-	vector< vec3 > normals; // Won't be used at the moment.
 	// Read our .obj file
-	bool objLoaded = loadOBJ(pathOBJ, vertices, uvs, normals);
+	if (!meshStreaming)
+		packOBJ(pathOBJ, pathMPK.c_str(), vertices);
+	bool objLoaded = meshStreaming || !vertices.empty();
 	unsigned int numVertices = vertices.size() / 6;
 	// If obj data was not loaded, we'll use this debug vertex data
 	// ------------------------------------------------------------------
@@ -167,7 +179,11 @@ int main(void)
 	glBindVertexArray(VAO);
 	// 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	if (objLoaded) {
+	if (meshStreaming) {
+		// allocate the whole mesh up front; chunks are copied in as they are decoded
+		glBufferData(GL_ARRAY_BUFFER, meshStream.totalVertices() * 6 * sizeof(float), NULL, GL_STATIC_DRAW);
+	}
+	else if (objLoaded) {
 		// set up array buffer pointers based on vertices loaded from obj
 		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
 	}
@@ -215,6 +231,23 @@ int main(void)
 		// -----
 		processInput(window);
 
+		// upload any mesh chunks decoded since the last frame
+		// ---------------------------------------------------
+		vector< float > chunk;
+		while (meshStreaming && meshStream.poll(chunk))
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			glBufferSubData(GL_ARRAY_BUFFER, numVertices * 6 * sizeof(float), chunk.size() * sizeof(float), chunk.data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			numVertices += chunk.size() / 6;
+		}
+		if (firstTriangle && objLoaded && numVertices > 0)
+		{
+			printf("Time to first triangle: %.2f ms%s\n", (glfwGetTime() - loadStart) * 1000.0,
+				meshStreaming ? "" : " (includes parsing and packing the OBJ on this run)");
+			firstTriangle = false;
+		}
+
 		// render
 		// ------
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -257,6 +290,7 @@ int main(void)
 	// ------------------------------------------------------------------------
 	glDeleteVertexArrays(1, &VAO);
 	glDeleteBuffers(1, &VBO);
+	meshStream.close();
 	ourShader.del();
 
 	// glfw: clsose OpenGL window and terminate GLFW, clearing all allocated resources.
@@ -0,0 +1,732 @@
+// author: david allen <d@preform.io>
+// rANS entropy coder after: https://github.com/rygorous/ryg_rans
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glm/glm.hpp>
+using namespace glm;
+
+#include "objloader.h"
+#include "meshpack.h"
+
+namespace {
+    const char MAGIC[4] = { 'M', 'P', 'K', '1' };
+    const uint32_t VERSION = 5;
+    const size_t CHECKSUM_OFFSET = 80;
+    const size_t HEADER_SIZE = 84;
+    const size_t CHUNK_ENTRY_SIZE = 20;
+    const int ATTRIBUTES = 6; // three position args, three color args
+    const float QUANT_MAX = 65535.0f;
+
+    // rANS parameters: 32 bit state, byte-wise renormalization, 12 bit probabilities
+    const uint32_t RANS_L = 1u << 23;
+    const uint32_t SCALE_BITS = 12;
+    const uint32_t SCALE = 1u << SCALE_BITS;
+
+    // little-endian helpers
+    // ----------------
+    void putU32(vector< unsigned char > & out, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            out.push_back((unsigned char)(v >> (8 * i)));
+    }
+
+    void putF32(vector< unsigned char > & out, float f)
+    {
+        uint32_t v;
+        memcpy(&v, &f, sizeof(v));
+        putU32(out, v);
+    }
+
+    void putU64(vector< unsigned char > & out, uint64_t v)
+    {
+        putU32(out, (uint32_t)v);
+        putU32(out, (uint32_t)(v >> 32));
+    }
+
+    void setU32(vector< unsigned char > & out, size_t at, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            out[at + i] = (unsigned char)(v >> (8 * i));
+    }
+
+    uint32_t getU32(const unsigned char * p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    uint64_t getU64(const unsigned char * p)
+    {
+        return (uint64_t)getU32(p) | ((uint64_t)getU32(p + 4) << 32);
+    }
+
+    float getF32(const unsigned char * p)
+    {
+        uint32_t v = getU32(p);
+        float f;
+        memcpy(&f, &v, sizeof(f));
+        return f;
+    }
+
+    // FNV-1a; pass a previous result as hash to continue over another range
+    uint32_t fnv1a(const unsigned char * p, size_t size, uint32_t hash = 2166136261u)
+    {
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ p[i]) * 16777619u;
+        return hash;
+    }
+
+    // checksum of the header (minus its checksum field) and the chunk table
+    uint32_t tableChecksum(const vector< unsigned char > & data, size_t tableEnd)
+    {
+        uint32_t hash = fnv1a(data.data(), CHECKSUM_OFFSET);
+        return fnv1a(data.data() + HEADER_SIZE, tableEnd - HEADER_SIZE, hash);
+    }
+
+    // varint (LEB128) and zigzag helpers
+    // ----------------
+    void putVarint(vector< unsigned char > & out, uint32_t v)
+    {
+        while (v >= 0x80)
+        {
+            out.push_back((unsigned char)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((unsigned char)v);
+    }
+
+    bool getVarint(const unsigned char *& p, const unsigned char * end, uint32_t & v)
+    {
+        v = 0;
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (p >= end)
+                return false;
+            unsigned char b = *p++;
+            v |= (uint32_t)(b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    uint32_t zigzag(int32_t v)
+    {
+        return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+    }
+
+    int32_t unzigzag(uint32_t v)
+    {
+        return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+    }
+
+    // rANS order-0 byte coder
+    // ----------------
+    // scale symbol counts so they sum to SCALE while keeping every used symbol codable
+    void normalizeFreqs(const vector< unsigned char > & raw, uint32_t freqs[256])
+    {
+        uint32_t counts[256] = { 0 };
+        for (unsigned char b : raw)
+            counts[b]++;
+
+        uint32_t sum = 0;
+        int largest = 0;
+        for (int s = 0; s < 256; s++)
+        {
+            freqs[s] = 0;
+            if (counts[s] == 0)
+                continue;
+            freqs[s] = (uint32_t)(((uint64_t)counts[s] * SCALE) / raw.size());
+            if (freqs[s] == 0)
+                freqs[s] = 1;
+            sum += freqs[s];
+            if (freqs[s] > freqs[largest])
+                largest = s;
+        }
+        if (raw.empty())
+            return;
+
+        // hand the rounding error to the most frequent symbols
+        while (sum != SCALE)
+        {
+            if (sum < SCALE)
+            {
+                freqs[largest] += SCALE - sum;
+                sum = SCALE;
+            }
+            else
+            {
+                int victim = -1;
+                for (int s = 0; s < 256; s++)
+                    if (freqs[s] > 1 && (victim < 0 || freqs[s] > freqs[victim]))
+                        victim = s;
+                uint32_t take = std::min(sum - SCALE, freqs[victim] - 1);
+                freqs[victim] -= take;
+                sum -= take;
+            }
+        }
+    }
+
+    void ransEncode(const vector< unsigned char > & raw, vector< unsigned char > & out)
+    {
+        uint32_t freqs[256];
+        uint32_t starts[256];
+        normalizeFreqs(raw, freqs);
+        uint32_t start = 0;
+        for (int s = 0; s < 256; s++)
+        {
+            putVarint(out, freqs[s]);
+            starts[s] = start;
+            start += freqs[s];
+        }
+
+        // rANS encodes back to front, so collect bytes reversed and flip at the end
+        vector< unsigned char > stream;
+        uint32_t x = RANS_L;
+        for (size_t i = raw.size(); i-- > 0; )
+        {
+            unsigned char s = raw[i];
+            uint32_t xMax = ((RANS_L >> SCALE_BITS) << 8) * freqs[s];
+            while (x >= xMax)
+            {
+                stream.push_back((unsigned char)(x & 0xff));
+                x >>= 8;
+            }
+            x = ((x / freqs[s]) << SCALE_BITS) + (x % freqs[s]) + starts[s];
+        }
+        for (int i = 3; i >= 0; i--)
+            stream.push_back((unsigned char)(x >> (8 * i)));
+
+        out.insert(out.end(), stream.rbegin(), stream.rend());
+    }
+
+    bool ransDecode(const unsigned char * p, const unsigned char * end, uint32_t rawSize, vector< unsigned char > & raw)
+    {
+        uint32_t freqs[256];
+        uint32_t starts[256];
+        uint32_t start = 0;
+        for (int s = 0; s < 256; s++)
+        {
+            if (!getVarint(p, end, freqs[s]) || freqs[s] > SCALE)
+                return false;
+            starts[s] = start;
+            start += freqs[s];
+        }
+        if (start != SCALE || end - p < 4)
+            return false;
+        raw.resize(rawSize);
+
+        unsigned char lookup[SCALE];
+        for (int s = 0; s < 256; s++)
+            memset(lookup + starts[s], s, freqs[s]);
+
+        uint32_t x = getU32(p);
+        p += 4;
+        for (uint32_t i = 0; i < rawSize; i++)
+        {
+            uint32_t slot = x & (SCALE - 1);
+            unsigned char s = lookup[slot];
+            raw[i] = s;
+            x = freqs[s] * (x >> SCALE_BITS) + slot - starts[s];
+            while (x < RANS_L)
+            {
+                if (p >= end)
+                    return false;
+                x = (x << 8) | *p++;
+            }
+        }
+        // the encoder started from RANS_L, so a clean stream ends there with every byte used
+        return x == RANS_L && p == end;
+    }
+
+    long long fileSize(const char * path)
+    {
+        ifstream file(path, ios::binary | ios::ate);
+        if (!file)
+            return -1;
+        return (long long)file.tellg();
+    }
+
+    // bounds on the raw stream of a chunk with vertexCount vertices: two count varints (at most
+    // 5 bytes each), then per vertex at most one unique vertex (6 attribute deltas of at most
+    // 3 bytes) and one index delta (at least 1, at most 5 bytes)
+    uint64_t minRawSize(uint32_t vertexCount)
+    {
+        return 2 + (uint64_t)vertexCount;
+    }
+
+    uint64_t maxRawSize(uint32_t vertexCount)
+    {
+        return 2 * 5 + (uint64_t)vertexCount * (ATTRIBUTES * 3 + 5);
+    }
+
+    // size and last write time identify the version of the OBJ a pack was made from
+    bool sourceStamp(const char * path, uint64_t & size, int64_t & time)
+    {
+        struct _stat64 info;
+        if (_stat64(path, &info) != 0)
+            return false;
+        size = (uint64_t)info.st_size;
+        time = (int64_t)info.st_mtime;
+        return true;
+    }
+}
+
+string lMPK::packPath(const char * pathOBJ)
+{
+    // only a dot after the last directory separator starts an extension
+    string path(pathOBJ);
+    size_t dot = path.find_last_of('.');
+    size_t separator = path.find_last_of("/\\");
+    if (dot == string::npos || (separator != string::npos && dot < separator))
+        return path + ".mpk";
+    return path.substr(0, dot) + ".mpk";
+}
+
+bool lMPK::packOBJ(
+    const char * pathOBJ,
+    const char * pathPack,
+    vector < float > & out_vertices,
+    unsigned int trianglesPerChunk
+)
+{
+    cout << "lMPK::packOBJ() Executing." << endl;
+
+    vector< vec2 > uvs;
+    vector< vec3 > normals;
+    out_vertices.clear();
+    if (!lOBJ::loadOBJ(pathOBJ, out_vertices, uvs, normals))
+    {
+        out_vertices.clear();
+        return false;
+    }
+    if (!packMesh(pathPack, out_vertices, pathOBJ, trianglesPerChunk))
+        return false;
+
+    long long objBytes = fileSize(pathOBJ);
+    long long packBytes = fileSize(pathPack);
+    if (objBytes > 0 && packBytes > 0)
+    {
+        printf("'%s' %lld bytes -> '%s' %lld bytes (%.2f:1 against OBJ)\n",
+            pathOBJ, objBytes, pathPack, packBytes, (double)objBytes / packBytes);
+    }
+    return true;
+}
+
+bool lMPK::packMesh(
+    const char * pathPack,
+    const vector < float > & vertices,
+    const char * pathSource,
+    unsigned int trianglesPerChunk
+)
+{
+    cout << "lMPK::packMesh() Executing." << endl;
+
+    const unsigned int floatsPerTriangle = 3 * ATTRIBUTES;
+    unsigned int numVertices = (unsigned int)(vertices.size() / ATTRIBUTES);
+    unsigned int numTriangles = numVertices / 3;
+    if (numTriangles == 0 || trianglesPerChunk == 0)
+    {
+        printf("Nothing to pack into '%s'\n", pathPack);
+        return false;
+    }
+    unsigned int chunkCount = (numTriangles + trianglesPerChunk - 1) / trianglesPerChunk;
+
+    // quantization range of every attribute over the whole mesh
+    // ----------------
+    float attrMin[ATTRIBUTES], attrMax[ATTRIBUTES], attrScale[ATTRIBUTES];
+    for (int a = 0; a < ATTRIBUTES; a++)
+    {
+        attrMin[a] = vertices[a];
+        attrMax[a] = vertices[a];
+    }
+    for (size_t i = 0; i < (size_t)numTriangles * floatsPerTriangle; i++)
+    {
+        int a = (int)(i % ATTRIBUTES);
+        attrMin[a] = std::min(attrMin[a], vertices[i]);
+        attrMax[a] = std::max(attrMax[a], vertices[i]);
+    }
+    for (int a = 0; a < ATTRIBUTES; a++)
+        attrScale[a] = attrMax[a] > attrMin[a] ? QUANT_MAX / (attrMax[a] - attrMin[a]) : 0.0f;
+
+    // header and an empty chunk table, patched once the payloads are known
+    // ----------------
+    vector< unsigned char > out;
+    out.insert(out.end(), MAGIC, MAGIC + 4);
+    putU32(out, VERSION);
+    putU32(out, chunkCount);
+    putU32(out, numTriangles * 3);
+    for (int a = 0; a < ATTRIBUTES; a++)
+        putF32(out, attrMin[a]);
+    for (int a = 0; a < ATTRIBUTES; a++)
+        putF32(out, attrMax[a]);
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (pathSource != nullptr)
+        sourceStamp(pathSource, sourceSize, sourceTime);
+    putU64(out, sourceSize);
+    putU64(out, (uint64_t)sourceTime);
+    putU32(out, 0); // checksum, filled in last
+    out.resize(HEADER_SIZE + (size_t)chunkCount * CHUNK_ENTRY_SIZE);
+
+    // encode each chunk on its own so it can be decoded without its neighbours
+    // ----------------
+    for (unsigned int c = 0; c < chunkCount; c++)
+    {
+        unsigned int firstVertex = c * trianglesPerChunk * 3;
+        unsigned int lastVertex = std::min((c + 1) * trianglesPerChunk, numTriangles) * 3;
+
+        // de-duplicate quantized vertices in order of first use so index deltas stay small
+        map< array< uint16_t, ATTRIBUTES >, uint32_t > uniqueIndex;
+        vector< array< uint16_t, ATTRIBUTES > > unique;
+        vector< uint32_t > indices;
+        for (unsigned int v = firstVertex; v < lastVertex; v++)
+        {
+            array< uint16_t, ATTRIBUTES > q;
+            for (int a = 0; a < ATTRIBUTES; a++)
+            {
+                float scaled = (vertices[(size_t)v * ATTRIBUTES + a] - attrMin[a]) * attrScale[a] + 0.5f;
+                q[a] = (uint16_t)std::min(std::max(scaled, 0.0f), QUANT_MAX);
+            }
+            auto found = uniqueIndex.find(q);
+            if (found == uniqueIndex.end())
+            {
+                found = uniqueIndex.emplace(q, (uint32_t)unique.size()).first;
+                unique.push_back(q);
+            }
+            indices.push_back(found->second);
+        }
+
+        // delta + zigzag + varint byte stream
+        vector< unsigned char > raw;
+        putVarint(raw, (uint32_t)unique.size());
+        int32_t previous[ATTRIBUTES] = { 0 };
+        for (const auto & q : unique)
+        {
+            for (int a = 0; a < ATTRIBUTES; a++)
+            {
+                putVarint(raw, zigzag((int32_t)q[a] - previous[a]));
+                previous[a] = q[a];
+            }
+        }
+        putVarint(raw, (uint32_t)indices.size());
+        int32_t previousIndex = 0;
+        for (uint32_t index : indices)
+        {
+            putVarint(raw, zigzag((int32_t)index - previousIndex));
+            previousIndex = (int32_t)index;
+        }
+
+        // entropy code the byte stream
+        size_t offset = out.size();
+        ransEncode(raw, out);
+
+        size_t entry = HEADER_SIZE + (size_t)c * CHUNK_ENTRY_SIZE;
+        setU32(out, entry + 0, (uint32_t)offset);
+        setU32(out, entry + 4, (uint32_t)(out.size() - offset));
+        setU32(out, entry + 8, (uint32_t)raw.size());
+        setU32(out, entry + 12, (uint32_t)indices.size());
+        setU32(out, entry + 16, fnv1a(&out[offset], out.size() - offset));
+    }
+
+    setU32(out, CHECKSUM_OFFSET, tableChecksum(out, HEADER_SIZE + (size_t)chunkCount * CHUNK_ENTRY_SIZE));
+
+    ofstream file(pathPack, ios::binary | ios::trunc);
+    if (!file)
+    {
+        printf("The file '%s' was not opened for writing\n", pathPack);
+        return false;
+    }
+    file.write((const char *)out.data(), out.size());
+    if (!file)
+    {
+        printf("The file '%s' could not be written\n", pathPack);
+        return false;
+    }
+
+    size_t rawBytes = (size_t)numTriangles * floatsPerTriangle * sizeof(float);
+    printf("'%s' packed %u triangles into %u chunks: %zu bytes (%.2f:1 against raw float vertices)\n",
+        pathPack, numTriangles, chunkCount, out.size(), (double)rawBytes / out.size());
+    return true;
+}
+
+lMPK::MeshStream::MeshStream()
+    : attrMin(), attrMax(), vertexTotal(0), nextChunk(0), stopping(false), chunksDelivered(0), chunksFailed(0), decodeNanoseconds(0), decodedBytes(0)
+{
+}
+
+lMPK::MeshStream::~MeshStream()
+{
+    close();
+}
+
+bool lMPK::MeshStream::open(const char * path, const char * pathSource)
+{
+    cout << "lMPK::MeshStream::open() Executing." << endl;
+    close();
+
+    // read the whole container; it is small compared to the decoded mesh
+    // ----------------
+    ifstream file(path, ios::binary | ios::ate);
+    if (!file)
+    {
+        printf("The file '%s' was not opened\n", path);
+        return false;
+    }
+    fileData.resize((size_t)file.tellg());
+    file.seekg(0);
+    file.read((char *)fileData.data(), fileData.size());
+    if (!file || fileData.size() < HEADER_SIZE || memcmp(fileData.data(), MAGIC, 4) != 0 || getU32(&fileData[4]) != VERSION)
+    {
+        printf("The file '%s' is not a mesh pack\n", path);
+        fileData.clear();
+        return false;
+    }
+
+    // header and chunk table
+    // ----------------
+    uint32_t chunkCount = getU32(&fileData[8]);
+    if ((fileData.size() - HEADER_SIZE) / CHUNK_ENTRY_SIZE < chunkCount)
+    {
+        printf("The file '%s' has a truncated chunk table\n", path);
+        fileData.clear();
+        return false;
+    }
+    size_t tableEnd = HEADER_SIZE + (size_t)chunkCount * CHUNK_ENTRY_SIZE;
+
+    // a damaged header or table fails here so the pack gets rebuilt; chunk payloads
+    // carry their own checksums, checked by the workers so decoding can start at once
+    if (tableChecksum(fileData, tableEnd) != getU32(&fileData[CHECKSUM_OFFSET]))
+    {
+        printf("The file '%s' failed its checksum\n", path);
+        fileData.clear();
+        return false;
+    }
+
+    vertexTotal = getU32(&fileData[12]);
+    for (int a = 0; a < ATTRIBUTES; a++)
+    {
+        attrMin[a] = getF32(&fileData[16 + 4 * a]);
+        attrMax[a] = getF32(&fileData[40 + 4 * a]);
+    }
+
+    // a pack is a cache of its OBJ; refuse it once the OBJ has changed
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (pathSource != nullptr && sourceStamp(pathSource, sourceSize, sourceTime)
+        && (sourceSize != getU64(&fileData[64]) || sourceTime != (int64_t)getU64(&fileData[72])))
+    {
+        printf("The file '%s' is out of date with '%s'\n", path, pathSource);
+        fileData.clear();
+        return false;
+    }
+    uint64_t vertexSum = 0;
+    for (uint32_t c = 0; c < chunkCount; c++)
+    {
+        const unsigned char * entry = &fileData[HEADER_SIZE + (size_t)c * CHUNK_ENTRY_SIZE];
+        Chunk chunk = { getU32(entry), getU32(entry + 4), getU32(entry + 8), getU32(entry + 12), getU32(entry + 16) };
+        // compare without adding: offset + size can wrap where size_t is 32 bits
+        if (chunk.offset < tableEnd || chunk.offset > fileData.size() || chunk.compressedSize > fileData.size() - chunk.offset)
+        {
+            printf("The file '%s' has a chunk outside its payload\n", path);
+            fileData.clear();
+            chunks.clear();
+            return false;
+        }
+        // rawSize sizes the decode buffer, so keep it within what vertexCount can need
+        if (chunk.rawSize < minRawSize(chunk.vertexCount) || chunk.rawSize > maxRawSize(chunk.vertexCount))
+        {
+            printf("The file '%s' has a chunk with an impossible raw size\n", path);
+            fileData.clear();
+            chunks.clear();
+            return false;
+        }
+        vertexSum += chunk.vertexCount;
+        chunks.push_back(chunk);
+    }
+    if (vertexSum != vertexTotal)
+    {
+        printf("The file '%s' has an inconsistent vertex count\n", path);
+        fileData.clear();
+        chunks.clear();
+        return false;
+    }
+    printf("The file '%s' was opened: %u chunks, %u vertices\n", path, chunkCount, vertexTotal);
+
+    // compression ratio against the OBJ the pack was made from, recorded in its stamp
+    uint64_t objBytes = getU64(&fileData[64]);
+    double rawBytes = (double)vertexTotal * ATTRIBUTES * sizeof(float);
+    if (objBytes > 0)
+        printf("'%s' is %zu bytes (%.2f:1 against %llu byte OBJ, %.2f:1 against raw float vertices)\n",
+            path, fileData.size(), (double)objBytes / fileData.size(), (unsigned long long)objBytes, rawBytes / fileData.size());
+    else
+        printf("'%s' is %zu bytes (%.2f:1 against raw float vertices)\n",
+            path, fileData.size(), rawBytes / fileData.size());
+
+    // start decoding, leaving one core for the render thread
+    // ----------------
+    unsigned int numWorkers = std::max(thread::hardware_concurrency(), 2u) - 1;
+    numWorkers = std::min(numWorkers, (unsigned int)chunks.size());
+    for (unsigned int i = 0; i < numWorkers; i++)
+        workers.emplace_back(&MeshStream::decodeWorker, this);
+
+    return true;
+}
+
+bool lMPK::MeshStream::poll(vector < float > & out_vertices)
+{
+    {
+        lock_guard< mutex > lock(readyMutex);
+        if (ready.empty())
+            return false;
+        out_vertices.swap(ready.front());
+        ready.pop_front();
+    }
+    chunksDelivered++;
+
+    // report once the last chunk has been handed out; throughput counts worker decode time
+    // only, not the frames the render thread spent between polls
+    if (done())
+    {
+        double decodeSeconds = decodeNanoseconds.load() * 1e-9;
+        double decodedMB = decodedBytes.load() / (1024.0 * 1024.0);
+        printf("Mesh stream decoded %zu of %zu chunks on %zu workers: %.2f MB in %.2f ms of decode time (%.1f MB/s decode throughput)\n",
+            chunks.size() - chunksFailed.load(), chunks.size(), workers.size(),
+            decodedMB, decodeSeconds * 1000.0,
+            decodeSeconds > 0.0 ? decodedMB / decodeSeconds : 0.0);
+    }
+    return true;
+}
+
+bool lMPK::MeshStream::done() const
+{
+    return chunksDelivered == chunks.size();
+}
+
+unsigned int lMPK::MeshStream::totalVertices() const
+{
+    return vertexTotal;
+}
+
+void lMPK::MeshStream::close()
+{
+    stopping = true;
+    for (thread & worker : workers)
+        worker.join();
+    workers.clear();
+
+    fileData.clear();
+    chunks.clear();
+    ready.clear();
+    vertexTotal = 0;
+    nextChunk = 0;
+    chunksDelivered = 0;
+    chunksFailed = 0;
+    decodeNanoseconds = 0;
+    decodedBytes = 0;
+    stopping = false;
+}
+
+void lMPK::MeshStream::decodeWorker()
+{
+    while (!stopping)
+    {
+        unsigned int c = nextChunk++;
+        if (c >= chunks.size())
+            return;
+
+        auto start = chrono::steady_clock::now();
+        vector< float > decoded;
+        bool decodedOK;
+        try
+        {
+            decodedOK = decodeChunk(chunks[c], decoded);
+        }
+        catch (const exception &)
+        {
+            // an exception escaping a worker would terminate the application
+            decodedOK = false;
+        }
+        if (!decodedOK)
+        {
+            // a bad chunk is dropped; the rest of the mesh still displays
+            printf("Mesh stream chunk %u could not be decoded\n", c);
+            decoded.clear();
+            chunksFailed++;
+        }
+        decodeNanoseconds += chrono::duration_cast< chrono::nanoseconds >(chrono::steady_clock::now() - start).count();
+        decodedBytes += (long long)(decoded.size() * sizeof(float));
+
+        lock_guard< mutex > lock(readyMutex);
+        ready.push_back(move(decoded));
+    }
+}
+
+bool lMPK::MeshStream::decodeChunk(const Chunk & chunk, vector < float > & out_vertices) const
+{
+    // entropy decode
+    // ----------------
+    const unsigned char * payload = &fileData[chunk.offset];
+    if (fnv1a(payload, chunk.compressedSize) != chunk.checksum)
+        return false;
+    vector< unsigned char > raw;
+    if (!ransDecode(payload, payload + chunk.compressedSize, chunk.rawSize, raw))
+        return false;
+    const unsigned char * p = raw.data();
+    const unsigned char * end = p + raw.size();
+
+    // unique vertices, dequantized straight to floats
+    // ----------------
+    float attrStep[ATTRIBUTES];
+    for (int a = 0; a < ATTRIBUTES; a++)
+        attrStep[a] = (attrMax[a] - attrMin[a]) / QUANT_MAX;
+
+    uint32_t uniqueCount;
+    if (!getVarint(p, end, uniqueCount) || uniqueCount > chunk.vertexCount)
+        return false;
+    vector< float > unique((size_t)uniqueCount * ATTRIBUTES);
+    // unsigned accumulators so corrupt deltas wrap instead of overflowing
+    uint32_t previous[ATTRIBUTES] = { 0 };
+    for (size_t i = 0; i < unique.size(); i++)
+    {
+        int a = (int)(i % ATTRIBUTES);
+        uint32_t delta;
+        if (!getVarint(p, end, delta))
+            return false;
+        previous[a] += (uint32_t)unzigzag(delta);
+        unique[i] = attrMin[a] + previous[a] * attrStep[a];
+    }
+
+    // expand indices into the de-indexed layout the renderer draws
+    // ----------------
+    uint32_t indexCount;
+    if (!getVarint(p, end, indexCount) || indexCount != chunk.vertexCount)
+        return false;
+    out_vertices.resize((size_t)indexCount * ATTRIBUTES);
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < indexCount; i++)
+    {
+        uint32_t delta;
+        if (!getVarint(p, end, delta))
+            return false;
+        index += (uint32_t)unzigzag(delta);
+        if (index >= uniqueCount)
+            return false;
+        memcpy(&out_vertices[(size_t)i * ATTRIBUTES], &unique[(size_t)index * ATTRIBUTES], ATTRIBUTES * sizeof(float));
+    }
+    return p == end;
+}
@@ -0,0 +1,114 @@
+// author: david allen <d@preform.io>
+// compressed, chunked mesh container that can be decoded progressively on worker threads.
+//
+// binary layout (all fields little-endian)
+// ----------------
+//   offset  size            field
+//   0       4               magic "MPK1"
+//   4       4               u32 version (5)
+//   8       4               u32 chunkCount
+//   12      4               u32 totalVertices (de-indexed, 3 per triangle)
+//   16      24              f32 attrMin[6] (x, y, z, r, g, b)
+//   40      24              f32 attrMax[6]
+//   64      8               u64 source OBJ size in bytes
+//   72      8               i64 source OBJ last write time (seconds since 1970)
+//   80      4               u32 FNV-1a checksum of bytes 0-79 and the chunk table
+//   84      20*chunkCount   chunk table: u32 offset, u32 compressedSize, u32 rawSize, u32 vertexCount,
+//                           u32 FNV-1a checksum of the chunk payload
+//   ...                     chunk payloads
+//
+// every chunk is independently decodable:
+//   payload = 256 varint symbol frequencies (sum 4096) + rANS coded byte stream of rawSize bytes
+//   raw     = varint uniqueCount,
+//             uniqueCount * 6 zigzag varint deltas of 16 bit quantized attributes,
+//             varint indexCount,
+//             indexCount zigzag varint deltas of chunk-local vertex indices
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+using namespace std;
+
+#ifndef H_MESHPACK
+#define H_MESHPACK
+
+namespace lMPK {
+    // pack path used for an OBJ: the same path with its extension swapped for .mpk
+    string packPath(const char * pathOBJ);
+
+    // load an OBJ with lOBJ::loadOBJ() and write it to pathPack as an MPK1 container;
+    // out_vertices keeps the parsed vertices even if the pack can't be written
+    bool packOBJ(
+        const char * pathOBJ,
+        const char * pathPack,
+        vector < float > & out_vertices,
+        unsigned int trianglesPerChunk = 1024
+    );
+
+    // write already de-indexed vertices (6 floats each: position, color) as an MPK1 container;
+    // pathSource (may be nullptr) is the file the vertices came from, stamped so stale packs are noticed
+    bool packMesh(
+        const char * pathPack,
+        const vector < float > & vertices,
+        const char * pathSource,
+        unsigned int trianglesPerChunk = 1024
+    );
+
+    // streams an MPK1 container: chunks are decoded on worker threads and
+    // handed back to the caller (usually the render thread) as they finish
+    class MeshStream
+    {
+    public:
+        MeshStream();
+        ~MeshStream();
+
+        // read the container and start decoding; returns false if the file can't be used
+        // or, when pathSource is given, if it was packed from a different version of that file
+        bool open(const char * path, const char * pathSource = nullptr);
+        // pop one decoded chunk (6 floats per vertex) if one is ready; never blocks
+        bool poll(vector < float > & out_vertices);
+        // true once every chunk has been handed out by poll()
+        bool done() const;
+        // total number of vertices the finished mesh will have
+        unsigned int totalVertices() const;
+        // stop the workers and release the file contents
+        void close();
+
+    private:
+        struct Chunk
+        {
+            unsigned int offset;
+            unsigned int compressedSize;
+            unsigned int rawSize;
+            unsigned int vertexCount;
+            unsigned int checksum;
+        };
+
+        void decodeWorker();
+        bool decodeChunk(const Chunk & chunk, vector < float > & out_vertices) const;
+
+        vector < unsigned char > fileData;
+        vector < Chunk > chunks;
+        float attrMin[6];
+        float attrMax[6];
+        unsigned int vertexTotal;
+
+        vector < thread > workers;
+        atomic < unsigned int > nextChunk;
+        atomic < bool > stopping;
+        mutex readyMutex;
+        deque < vector < float > > ready;
+        unsigned int chunksDelivered;
+
+        atomic < unsigned int > chunksFailed;
+        atomic < long long > decodeNanoseconds;
+        atomic < long long > decodedBytes;
+    };
+}
+
+
+#endif //!H_MESHPACK